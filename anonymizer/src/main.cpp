@@ -0,0 +1,426 @@
+/**
+ * @file main.cpp
+ *
+ * This module contains the entry point of the UriAnonymizer program,
+ * which rewrites a corpus of URIs, one per line, with Uri::Anonymizer
+ * so that it can be shared for benchmarking.
+ *
+ *     UriAnonymizer <input> <output> [key] [threads]
+ *
+ * The key is 128 bits long, written as 32 hexadecimal digits.  It seeds
+ * the scrambling and must be kept secret: anyone who knows it can
+ * anonymize candidate URIs and match them against the corpus.  If it
+ * is omitted, or given as "random", a random key is used and printed,
+ * so that further corpora can be made consistent with this one.
+ *
+ * The input file is memory-mapped and handed out to the threads in
+ * chunks of about a megabyte, ending at line boundaries.  Each chunk is
+ * written as soon as it and every earlier one are done, so the output
+ * keeps the order of the input while memory use stays bounded.  Lines
+ * which fail to parse are dropped.
+ *
+ */
+
+#include <algorithm>
+#include <condition_variable>
+#include <errno.h>
+#include <fcntl.h>
+#include <mutex>
+#include <random>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <system_error>
+#include <thread>
+#include <unistd.h>
+#include <Uri/Anonymizer.h>
+#include <vector>
+
+namespace {
+
+    /**
+     * This is the largest number of threads which may be requested.
+     */
+    constexpr unsigned long long MAX_THREADS = 256;
+
+    /**
+     * This function parses a non-negative integer argument, in decimal,
+     * or in hexadecimal or octal with the usual C prefixes.
+     *
+     * @param[in] argument
+     *      This is the argument to parse.
+     *
+     * @param[out] value
+     *      A reference to store the value of the argument.
+     *
+     * @return
+     *      An indication of whether or not the whole argument is a
+     *      valid number is returned.
+     */
+    bool ParseNumber(const char* argument, unsigned long long& value) {
+        if ((*argument < '0') || (*argument > '9')) {
+            return false;
+        }
+        char* end;
+        errno = 0;
+        value = strtoull(argument, &end, 0);
+        return (errno == 0) && (*end == '\0');
+    }
+
+    /**
+     * This function parses a 128-bit key argument, given as exactly
+     * 32 hexadecimal digits.
+     *
+     * @param[in] argument
+     *      This is the argument to parse.
+     *
+     * @param[out] key
+     *      A reference to store the two halves of the key, with the
+     *      first 16 digits in the first half.
+     *
+     * @return
+     *      An indication of whether or not the argument is a valid
+     *      key is returned.
+     */
+    bool ParseKey(const char* argument, uint64_t (&key)[2]) {
+        if (strlen(argument) != 32) {
+            return false;
+        }
+        for (size_t i = 0; i < 32; ++i) {
+            const auto c = argument[i];
+            uint64_t digit;
+            if ((c >= '0') && (c <= '9')) {
+                digit = (uint64_t)(c - '0');
+            }
+            else if ((c >= 'a') && (c <= 'f')) {
+                digit = (uint64_t)(c - 'a' + 10);
+            }
+            else if ((c >= 'A') && (c <= 'F')) {
+                digit = (uint64_t)(c - 'A' + 10);
+            }
+            else {
+                return false;
+            }
+            key[i / 16] = (key[i / 16] << 4) | digit;
+        }
+        return true;
+    }
+
+    /**
+     * This is the approximate size of the chunks of input which are
+     * handed out to the threads.  Each thread holds the output of at
+     * most one chunk, so this bounds the memory used for output.
+     */
+    constexpr size_t CHUNK_SIZE = 1 << 20;
+
+    /**
+     * This holds the state shared by the threads which anonymize
+     * the input.
+     */
+    struct Job {
+        /**
+         * This is the anonymizer to use.
+         */
+        const Uri::Anonymizer* anonymizer = nullptr;
+
+        /**
+         * This points to the first character of the input which has
+         * not yet been handed out to a thread.
+         */
+        const char* next = nullptr;
+
+        /**
+         * This points just past the last character of the input.
+         */
+        const char* end = nullptr;
+
+        /**
+         * This is where the anonymized URIs are written.
+         */
+        FILE* output = nullptr;
+
+        /**
+         * This is the index of the next chunk to hand out.
+         */
+        size_t numChunks = 0;
+
+        /**
+         * This is the index of the next chunk to write.
+         */
+        size_t numWritten = 0;
+
+        /**
+         * This is the number of lines which were anonymized.
+         */
+        size_t accepted = 0;
+
+        /**
+         * This is the number of lines which failed to parse.
+         */
+        size_t rejected = 0;
+
+        /**
+         * This indicates whether or not the threads should stop,
+         * because the output could not be written, or not all of
+         * the threads could be started.
+         */
+        bool failed = false;
+
+        /**
+         * This is the error which occurred when writing the output,
+         * if any.
+         */
+        int writeError = 0;
+
+        /**
+         * This protects the properties above.
+         */
+        std::mutex mutex;
+
+        /**
+         * This is used to wake up the threads waiting for their
+         * turn to write a chunk.
+         */
+        std::condition_variable turnCondition;
+    };
+
+    /**
+     * This function anonymizes every line in the given chunk of input.
+     *
+     * @param[in] anonymizer
+     *      This is the anonymizer to use.
+     *
+     * @param[in] begin
+     *      This points to the first character of the chunk.
+     *
+     * @param[in] end
+     *      This points just past the last character of the chunk.
+     *
+     * @param[out] output
+     *      This is where to store the anonymized rendering of the chunk.
+     *
+     * @param[out] accepted
+     *      This is where to store the number of lines anonymized.
+     *
+     * @param[out] rejected
+     *      This is where to store the number of lines which failed
+     *      to parse.
+     */
+    void AnonymizeChunk(
+        const Uri::Anonymizer& anonymizer,
+        const char* begin,
+        const char* end,
+        std::string& output,
+        size_t& accepted,
+        size_t& rejected
+    ) {
+        std::string line;
+        std::string anonymized;
+        output.clear();
+        accepted = 0;
+        rejected = 0;
+        for (auto lineBegin = begin; lineBegin < end;) {
+            auto lineEnd = lineBegin;
+            while ((lineEnd < end) && (*lineEnd != '\n')) {
+                ++lineEnd;
+            }
+            const auto next = lineEnd + 1;
+            if ((lineEnd > lineBegin) && (lineEnd[-1] == '\r')) {
+                --lineEnd;
+            }
+            if (lineEnd > lineBegin) {
+                line.assign(lineBegin, lineEnd);
+                if (anonymizer.AnonymizeUri(line, anonymized)) {
+                    output += anonymized;
+                    output += '\n';
+                    ++accepted;
+                }
+                else {
+                    ++rejected;
+                }
+            }
+            lineBegin = next;
+        }
+    }
+
+    /**
+     * This is the body of each thread.  It repeatedly takes the next
+     * chunk of input, ending at a line boundary, anonymizes it, and
+     * waits for every earlier chunk to be written before writing it,
+     * so that the output keeps the order of the input.
+     *
+     * @param[in,out] job
+     *      This is the state shared by the threads.
+     */
+    void AnonymizeChunks(Job& job) {
+        std::string output;
+        for (;;) {
+            // Take the next chunk.
+            std::unique_lock<std::mutex> lock(job.mutex);
+            if (job.failed || (job.next == job.end)) {
+                return;
+            }
+            const auto chunkBegin = job.next;
+            auto chunkEnd = chunkBegin + std::min(CHUNK_SIZE, (size_t)(job.end - chunkBegin));
+            while ((chunkEnd < job.end) && (chunkEnd[-1] != '\n')) {
+                ++chunkEnd;
+            }
+            job.next = chunkEnd;
+            const auto chunk = job.numChunks++;
+            lock.unlock();
+
+            size_t accepted;
+            size_t rejected;
+            AnonymizeChunk(*job.anonymizer, chunkBegin, chunkEnd, output, accepted, rejected);
+
+            // Wait for our turn to write it.
+            lock.lock();
+            job.turnCondition.wait(
+                lock,
+                [&job, chunk]{ return job.failed || (job.numWritten == chunk); }
+            );
+            if (job.failed) {
+                return;
+            }
+            if (fwrite(output.data(), 1, output.length(), job.output) != output.length()) {
+                job.writeError = errno;
+                job.failed = true;
+            }
+            job.accepted += accepted;
+            job.rejected += rejected;
+            ++job.numWritten;
+            lock.unlock();
+            job.turnCondition.notify_all();
+        }
+    }
+
+}
+
+int main(int argc, char* argv[]) {
+    if ((argc < 3) || (argc > 5)) {
+        fprintf(stderr, "usage: %s <input> <output> [key] [threads]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    uint64_t key[2] = {0, 0};
+    if ((argc < 4) || (strcmp(argv[3], "random") == 0)) {
+        std::random_device randomDevice;
+        for (auto& half : key) {
+            half = ((uint64_t)randomDevice() << 32) | randomDevice();
+        }
+        fprintf(
+            stderr,
+            "key: %016llx%016llx\n",
+            (unsigned long long)key[0],
+            (unsigned long long)key[1]
+        );
+    }
+    else if (!ParseKey(argv[3], key)) {
+        fprintf(stderr, "%s: key must be 32 hexadecimal digits, or \"random\"\n", argv[3]);
+        return EXIT_FAILURE;
+    }
+    Uri::Anonymizer anonymizer(key[0], key[1]);
+    unsigned long long numThreads = std::thread::hardware_concurrency();
+    if (argc >= 5) {
+        if (
+            !ParseNumber(argv[4], numThreads)
+            || (numThreads == 0)
+            || (numThreads > MAX_THREADS)
+        ) {
+            fprintf(stderr, "%s: threads must be between 1 and %llu\n", argv[4], MAX_THREADS);
+            return EXIT_FAILURE;
+        }
+    }
+    if (numThreads == 0) {
+        numThreads = 1;
+    }
+    else if (numThreads > MAX_THREADS) {
+        numThreads = MAX_THREADS;
+    }
+
+    // Map the input into memory.
+    const auto input = open(argv[1], O_RDONLY);
+    if (input < 0) {
+        perror(argv[1]);
+        return EXIT_FAILURE;
+    }
+    struct stat inputStat;
+    if (fstat(input, &inputStat) != 0) {
+        perror(argv[1]);
+        (void)close(input);
+        return EXIT_FAILURE;
+    }
+    const auto size = (size_t)inputStat.st_size;
+    const char* data = "";
+    void* mapping = MAP_FAILED;
+    if (size > 0) {
+        mapping = mmap(NULL, size, PROT_READ, MAP_PRIVATE, input, 0);
+        if (mapping == MAP_FAILED) {
+            perror(argv[1]);
+            (void)close(input);
+            return EXIT_FAILURE;
+        }
+        (void)madvise(mapping, size, MADV_SEQUENTIAL);
+        data = (const char*)mapping;
+    }
+    (void)close(input);
+
+    // Open the output.
+    const auto output = fopen(argv[2], "wb");
+    if (output == NULL) {
+        perror(argv[2]);
+        if (mapping != MAP_FAILED) {
+            (void)munmap(mapping, size);
+        }
+        return EXIT_FAILURE;
+    }
+
+    // Anonymize the input in parallel, writing each chunk as soon as
+    // it and every earlier one are done.
+    Job job;
+    job.anonymizer = &anonymizer;
+    job.next = data;
+    job.end = data + size;
+    job.output = output;
+    std::vector<std::thread> threads;
+    auto threadsStarted = true;
+    for (size_t i = 0; i < numThreads; ++i) {
+        try {
+            threads.emplace_back(AnonymizeChunks, std::ref(job));
+        }
+        catch (const std::system_error& error) {
+            fprintf(stderr, "unable to start thread: %s\n", error.what());
+            threadsStarted = false;
+            {
+                std::lock_guard<std::mutex> lock(job.mutex);
+                job.failed = true;
+            }
+            job.turnCondition.notify_all();
+            break;
+        }
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    if (mapping != MAP_FAILED) {
+        (void)munmap(mapping, size);
+    }
+    if (!threadsStarted) {
+        (void)fclose(output);
+        return EXIT_FAILURE;
+    }
+    if (job.failed) {
+        fprintf(stderr, "%s: %s\n", argv[2], strerror(job.writeError));
+        (void)fclose(output);
+        return EXIT_FAILURE;
+    }
+    if (fclose(output) != 0) {
+        perror(argv[2]);
+        return EXIT_FAILURE;
+    }
+    fprintf(stderr, "%zu URIs anonymized, %zu rejected\n", job.accepted, job.rejected);
+    return EXIT_SUCCESS;
+}
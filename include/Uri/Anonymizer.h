@@ -0,0 +1,113 @@
+#ifndef URI_ANONYMIZER_H
+#define URI_ANONYMIZER_H
+
+/**
+ * @file Anonymizer.h
+ *
+ * This module declares the Uri::Anonymizer class.
+ *
+ */
+
+#include <stdint.h>
+#include <memory>
+#include <string>
+
+namespace Uri
+{
+    /**
+     * This class rewrites URIs so that their content is scrambled
+     * while their structure is preserved, so that corpora of real
+     * URIs can be shared (for example, for benchmarking) without
+     * exposing the original data.
+     *
+     * The following properties of a URI are preserved:
+     * - the scheme and port number, which are kept as they are;
+     * - which components are present, and the length of each of them;
+     * - all delimiters and other punctuation, and therefore the number
+     *   of path segments, host labels, query parameters, etc.;
+     * - which octets are percent-encoded;
+     * - the class of every octet, after decoding (lowercase letter,
+     *   uppercase letter, digit, punctuation or control octet), and
+     *   the encoded length of every UTF-8 sequence, so that valid
+     *   UTF-8 stays valid;
+     * - whether the host is an IPv4 address or an IP literal, which is
+     *   rewritten to another valid address of the same form.
+     *
+     * Hosts are mapped consistently: the same host (compared without
+     * regard to case) is always rewritten to the same scrambled host
+     * for a given key.  All other content is scrambled using a stream
+     * derived from the key and the entire URI.  Streams are seeded with
+     * SipHash-2-4, a keyed pseudo-random function, so that they cannot
+     * be reproduced without the key.
+     *
+     * @note
+     *      The AnonymizeUri method does not modify the instance, so a
+     *      single instance may be shared by several threads.
+     */
+    class Anonymizer
+    {
+        // Lifecycle management
+    public:
+        ~Anonymizer();
+        Anonymizer(const Anonymizer&) = delete;
+        Anonymizer(Anonymizer&&) = delete;
+        Anonymizer& operator=(const Anonymizer&) = delete;
+        Anonymizer& operator=(Anonymizer&&) = delete;
+
+        // Public methods
+    public:
+        /**
+         * This constructor sets the secret key which seeds the
+         * scrambling.  Different keys produce unrelated outputs for
+         * the same input.
+         *
+         * @note
+         *      The key must be secret and chosen at random: anyone who
+         *      knows it can anonymize candidate URIs and match them
+         *      against an anonymized corpus.
+         *
+         * @param[in] key0
+         *      This is the first half of the 128-bit key.
+         *
+         * @param[in] key1
+         *      This is the second half of the 128-bit key.
+         */
+        Anonymizer(uint64_t key0, uint64_t key1);
+
+        /**
+         * This method scrambles the content of the given URI while
+         * preserving its structure.
+         *
+         * @param[in] uriString
+         *      This is the string rendering of the URI to anonymize.
+         *
+         * @param[out] anonymizedUriString
+         *      A reference to store the anonymized URI, if the given
+         *      URI could be parsed.
+         *
+         * @return
+         *      An indication of whether or not the URI was
+         *      parsed and anonymized successfully is returned.
+         */
+        bool AnonymizeUri(
+            const std::string& uriString,
+            std::string& anonymizedUriString
+        ) const;
+
+        // private properties
+    private:
+        /**
+         * This is the type of structure that contains the private
+         * properties of the instance. It is defined in the implementation
+         * and declared here to ensure that it is scoped inside the class.
+         */
+        struct Impl;
+
+        /**
+         * This contains the private properties of the instance.
+         */
+        std::unique_ptr<struct Impl>impl_;
+    };
+}
+
+#endif /* URI_ANONYMIZER_H */
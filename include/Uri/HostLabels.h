@@ -0,0 +1,260 @@
+#ifndef URI_HOST_LABELS_H
+#define URI_HOST_LABELS_H
+
+/**
+ * @file HostLabels.h
+ *
+ * This module declares the Uri::HostLabels class.
+ *
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <iterator>
+#include <string_view>
+
+namespace Uri
+{
+    /**
+     * This class is a range over the labels of the "host" element of
+     * a URI, which are the parts of the host separated by ".".  It
+     * refers to the host and the label boundaries recorded by the URI
+     * while parsing, so iterating over it never allocates memory.
+     *
+     * @note
+     *      The range, and the string views it yields, are only valid
+     *      until the URI they came from is parsed again or destroyed.
+     */
+    class HostLabels
+    {
+        // Public types
+    public:
+        /**
+         * This is the type of iterator over the labels.  It yields
+         * each label as a string view into the host.
+         */
+        class Iterator
+        {
+        public:
+            using iterator_category = std::bidirectional_iterator_tag;
+            using value_type = std::string_view;
+            using difference_type = ptrdiff_t;
+            using pointer = void;
+            using reference = std::string_view;
+
+            Iterator() = default;
+
+            Iterator(std::string_view host, const uint32_t* labelEnds, size_t index)
+                : host_(host)
+                , labelEnds_(labelEnds)
+                , index_(index)
+            {
+            }
+
+            std::string_view operator*() const {
+                return Label(host_, labelEnds_, index_);
+            }
+
+            Iterator& operator++() {
+                ++index_;
+                return *this;
+            }
+
+            Iterator operator++(int) {
+                auto previous = *this;
+                ++index_;
+                return previous;
+            }
+
+            Iterator& operator--() {
+                --index_;
+                return *this;
+            }
+
+            Iterator operator--(int) {
+                auto previous = *this;
+                --index_;
+                return previous;
+            }
+
+            bool operator==(const Iterator& other) const {
+                return (labelEnds_ == other.labelEnds_) && (index_ == other.index_);
+            }
+
+            bool operator!=(const Iterator& other) const {
+                return !(*this == other);
+            }
+
+        private:
+            std::string_view host_;
+            const uint32_t* labelEnds_ = nullptr;
+            size_t index_ = 0;
+        };
+
+        /**
+         * This is the type of iterator over the labels, from the
+         * last (top-level) label to the first one.
+         */
+        using ReverseIterator = std::reverse_iterator<Iterator>;
+
+        /**
+         * This is a range over the labels, from the last (top-level)
+         * label to the first one.
+         */
+        class Reversed
+        {
+        public:
+            Reversed(ReverseIterator begin, ReverseIterator end)
+                : begin_(begin)
+                , end_(end)
+            {
+            }
+
+            ReverseIterator begin() const {
+                return begin_;
+            }
+
+            ReverseIterator end() const {
+                return end_;
+            }
+
+        private:
+            ReverseIterator begin_;
+            ReverseIterator end_;
+        };
+
+        // Public methods
+    public:
+        /**
+         * This constructs the range from a host and the offsets,
+         * within the host, of the end of each of its labels.
+         *
+         * @param[in] host
+         *      This is the host whose labels are to be iterated.
+         *
+         * @param[in] labelEnds
+         *      This points to the offset just past the end of each label.
+         *
+         * @param[in] numLabels
+         *      This is the number of labels in the host.
+         */
+        HostLabels(std::string_view host, const uint32_t* labelEnds, size_t numLabels)
+            : host_(host)
+            , labelEnds_(labelEnds)
+            , numLabels_(numLabels)
+        {
+        }
+
+        /**
+         * This method returns the number of labels in the host.
+         *
+         * @return
+         *      The number of labels in the host is returned.
+         *
+         * @retval 0
+         *      This is returned if the host is empty or is not a
+         *      registered name (for example, an IP address).
+         */
+        size_t size() const {
+            return numLabels_;
+        }
+
+        /**
+         * This method returns an indication of whether or not
+         * the host has no labels.
+         *
+         * @return
+         *      An indication of whether or not the host has no
+         *      labels is returned.
+         */
+        bool empty() const {
+            return numLabels_ == 0;
+        }
+
+        /**
+         * This method returns the label at the given position.
+         *
+         * @param[in] index
+         *      This is the position of the label, counting from
+         *      the first (leftmost) label.
+         *
+         * @return
+         *      The label at the given position is returned.
+         */
+        std::string_view operator[](size_t index) const {
+            return Label(host_, labelEnds_, index);
+        }
+
+        Iterator begin() const {
+            return Iterator(host_, labelEnds_, 0);
+        }
+
+        Iterator end() const {
+            return Iterator(host_, labelEnds_, numLabels_);
+        }
+
+        ReverseIterator rbegin() const {
+            return ReverseIterator(end());
+        }
+
+        ReverseIterator rend() const {
+            return ReverseIterator(begin());
+        }
+
+        /**
+         * This method returns a range over the labels, from the last
+         * (top-level) label to the first one.
+         *
+         * @return
+         *      A range over the labels in reverse order is returned.
+         */
+        Reversed Reverse() const {
+            return Reversed(rbegin(), rend());
+        }
+
+        // private methods
+    private:
+        /**
+         * This function returns one label of a host.
+         *
+         * @param[in] host
+         *      This is the host containing the label.
+         *
+         * @param[in] labelEnds
+         *      This points to the offset just past the end of each label.
+         *
+         * @param[in] index
+         *      This is the position of the label.
+         *
+         * @return
+         *      The label at the given position is returned.
+         */
+        static std::string_view Label(
+            std::string_view host,
+            const uint32_t* labelEnds,
+            size_t index
+        ) {
+            const size_t begin = (index == 0) ? 0 : labelEnds[index - 1] + 1;
+            return host.substr(begin, labelEnds[index] - begin);
+        }
+
+        // private properties
+    private:
+        /**
+         * This is the host whose labels are iterated.
+         */
+        std::string_view host_;
+
+        /**
+         * This points to the offset just past the end of each label.
+         */
+        const uint32_t* labelEnds_ = nullptr;
+
+        /**
+         * This is the number of labels in the host.
+         */
+        size_t numLabels_ = 0;
+    };
+}
+
+#endif /* URI_HOST_LABELS_H */
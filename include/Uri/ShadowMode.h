@@ -0,0 +1,176 @@
+#ifndef URI_SHADOW_MODE_H
+#define URI_SHADOW_MODE_H
+
+/**
+ * @file ShadowMode.h
+ *
+ * This module declares the Uri::ShadowMode class.
+ *
+ */
+
+#include <stdint.h>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <Uri/Uri.h>
+
+namespace Uri
+{
+    /**
+     * This class compares an alternative parse engine against the one
+     * in use, on real inputs, without slowing down the callers.
+     *
+     * Once attached to Uri instances (see Uri::SetShadowMode), a sampled
+     * fraction of their ParseFromString calls are queued, and parsed
+     * again on a background thread by a Uri instance using the shadow
+     * engine.  The results are compared element by element, and the
+     * outcome is accumulated into statistics.
+     *
+     * The queue is bounded.  Samples are dropped, rather than making
+     * the caller wait, when the queue is full or busy.
+     */
+    class ShadowMode
+    {
+        // Public types
+    public:
+        /**
+         * This holds the statistics accumulated by a shadow mode.
+         */
+        struct Statistics {
+            /**
+             * This is the number of calls which were selected to be
+             * compared.
+             */
+            uint64_t sampled = 0;
+
+            /**
+             * This is the number of sampled calls which were dropped
+             * because the queue was full or busy.
+             */
+            uint64_t dropped = 0;
+
+            /**
+             * This is the number of sampled calls which were parsed
+             * by the shadow engine and compared.
+             */
+            uint64_t compared = 0;
+
+            /**
+             * This is the number of compared calls for which the shadow
+             * engine did not produce the same result as the primary one.
+             */
+            uint64_t divergences = 0;
+
+            /**
+             * This is the total time spent by the primary engine
+             * parsing the compared calls.
+             */
+            std::chrono::nanoseconds primaryTime{0};
+
+            /**
+             * This is the total time spent by the shadow engine
+             * parsing the compared calls.
+             */
+            std::chrono::nanoseconds shadowTime{0};
+        };
+
+        // Lifecycle management
+    public:
+        ~ShadowMode();
+        ShadowMode(const ShadowMode&) = delete;
+        ShadowMode(ShadowMode&&) = delete;
+        ShadowMode& operator=(const ShadowMode&) = delete;
+        ShadowMode& operator=(ShadowMode&&) = delete;
+
+        // Public methods
+    public:
+        /**
+         * This constructor starts the background thread of the
+         * shadow mode.
+         *
+         * @param[in] engine
+         *      This is the engine to compare against the primary one.
+         *
+         * @param[in] sampleFraction
+         *      This is the fraction, between 0.0 and 1.0, of calls
+         *      to compare.
+         *
+         * @param[in] queueCapacity
+         *      This is the maximum number of sampled calls waiting
+         *      to be compared.
+         */
+        ShadowMode(
+            ParseEngine engine,
+            double sampleFraction,
+            size_t queueCapacity
+        );
+
+        /**
+         * This method decides whether or not the next call should
+         * be compared.  It never blocks.
+         *
+         * @note
+         *      Each call is sampled independently, with a probability
+         *      equal to the sample fraction, so the fraction holds on
+         *      average for every thread and every Uri instance.
+         *
+         * @return
+         *      An indication of whether or not the call should be
+         *      compared is returned.
+         */
+        bool ShouldSample();
+
+        /**
+         * This method queues a sampled call to be compared.  It never
+         * blocks; if the queue is full or busy, the sample is dropped.
+         *
+         * @param[in] uriString
+         *      This is the string rendering of the URI that was parsed.
+         *
+         * @param[in] primary
+         *      This is the instance which parsed the URI with the
+         *      primary engine.
+         *
+         * @param[in] primaryResult
+         *      This is the value returned by the primary engine.
+         *
+         * @param[in] primaryTime
+         *      This is the time taken by the primary engine.
+         */
+        void Submit(
+            const std::string& uriString,
+            const Uri& primary,
+            bool primaryResult,
+            std::chrono::nanoseconds primaryTime
+        );
+
+        /**
+         * This method waits until every queued call has been compared.
+         */
+        void WaitUntilIdle();
+
+        /**
+         * This method returns the statistics accumulated so far.
+         *
+         * @return
+         *      The statistics accumulated so far are returned.
+         */
+        Statistics GetStatistics() const;
+
+        // private properties
+    private:
+        /**
+         * This is the type of structure that contains the private
+         * properties of the instance. It is defined in the implementation
+         * and declared here to ensure that it is scoped inside the class.
+         */
+        struct Impl;
+
+        /**
+         * This contains the private properties of the instance.
+         */
+        std::unique_ptr<struct Impl>impl_;
+    };
+}
+
+#endif /* URI_SHADOW_MODE_H */
@@ -12,9 +12,29 @@
 #include <memory>
 #include <string>
 #include <vector>
+#include <Uri/HostLabels.h>
 
 namespace Uri
 {
+    class ShadowMode;
+
+    /**
+     * These are the engines which can be used to validate the
+     * elements of a URI while parsing it.
+     */
+    enum class ParseEngine {
+        /**
+         * This engine validates elements with regular expressions.
+         */
+        Regex,
+
+        /**
+         * This engine validates elements by scanning them one
+         * character at a time, without regular expressions.
+         */
+        Scanner,
+    };
+
     /**
      * This class represents a Uniform Resource Identifier (URI),
      * as defined in RFC 3986 (https://tools.ietf.org/html/rfc3986).
@@ -82,6 +102,44 @@ namespace Uri
          */
         std::string GetHost() const;
 
+        /**
+         * This method returns the labels of the "host" element of the
+         * URI, which are the parts of the host separated by ".", as a
+         * range of string views which can also be iterated in reverse.
+         * The label boundaries are recorded while parsing, so this does
+         * not allocate memory.
+         *
+         * @note
+         *      A host which ends with "." has an empty last label.
+         *
+         * @note
+         *      The returned range is only valid until the URI is parsed
+         *      again or destroyed.
+         *
+         * @return
+         *      The labels of the "host" element of the URI are returned.
+         *
+         * @retval empty
+         *      This is returned if there is no "host" element in the URI,
+         *      or if the host is an IP address rather than a registered name.
+         */
+        HostLabels GetHostLabels() const;
+
+        /**
+         * This method returns where the "host" element of the URI
+         * begins in the string rendering of the URI that was parsed.
+         * The host is followed by the port number, if there is one.
+         *
+         * @return
+         *      The index of the "host" element in the string rendering
+         *      of the URI is returned.
+         *
+         * @note
+         *      If there is no authority, the index where it would have
+         *      been, just after the scheme, is returned.
+         */
+        size_t GetHostOffset() const;
+
         /**
          * This method returns the "path" element of the URI,
          * as a sequence of segments.
@@ -161,6 +219,27 @@ namespace Uri
          */
         std::string GetFragment() const;
 
+        /**
+         * This method selects the engine used to validate the elements
+         * of URIs parsed by this instance.  The default is
+         * ParseEngine::Regex.
+         *
+         * @param[in] engine
+         *      This is the engine to use.
+         */
+        void SetParseEngine(ParseEngine engine);
+
+        /**
+         * This method attaches a shadow mode to this instance, so that a
+         * sample of the URIs it parses are also parsed by the shadow
+         * mode's engine on a background thread, and the results compared.
+         *
+         * @param[in] shadowMode
+         *      This is the shadow mode to attach, or nullptr to detach
+         *      any shadow mode which is currently attached.
+         */
+        void SetShadowMode(std::shared_ptr<ShadowMode> shadowMode);
+
         // private properties
     private:
         /**
@@ -177,6 +256,20 @@ namespace Uri
 
         // private methods
     private:
+        /**
+         * This method builds the URI from the elements parsed
+         * from the given string rendering of a URI, using the
+         * selected engine and without involving any shadow mode.
+         *
+         * @param[in] uriString
+         *      This is the string rendering of the URI to parse.
+         *
+         * @return
+         *      An indication of whether or not the URI was
+         *      parsed successfully is returned.
+         */
+        bool parse(const std::string& uriString);
+
         /**
          * This method parses the "scheme" part of the URI, returning the
          * scheme as a string, and sets nextIdx to the beginning of the next
@@ -213,6 +306,10 @@ namespace Uri
          * @param[in] uri
          *      The string rendering of the URI
          *
+         * @param[out] authorityIdx
+         *      A reference to store the index of the beginning of the
+         *      authority, or 0 if there is no authority.
+         *
          * @param[out] nextIdx
          *      A reference to store the index of the beginning of the next
          *      part of the URI.
@@ -223,7 +320,7 @@ namespace Uri
          * @retval ""
          *      This is returned if there is no authority.
          */
-        std::string parseAuthority(const std::string& uri, size_t& nextIdx);
+        std::string parseAuthority(const std::string& uri, size_t& authorityIdx, size_t& nextIdx);
 
         /**
          * This method parses the different components that can be present
@@ -240,7 +337,8 @@ namespace Uri
          *
          * @note
          *      These components are not returned, they are directly set
-         *      in the implementation instance.
+         *      in the implementation instance, along with the index of
+         *      the host within the authority.
          */
         bool parseAuthorityComponents(const std::string& authority);
     };
@@ -0,0 +1,630 @@
+/**
+ * @file Anonymizer.cpp
+ *
+ * This module contains the implementation of the Uri::Anonymizer class.
+ *
+ */
+
+#include <ctype.h>
+#include <string>
+#include <Uri/Anonymizer.h>
+#include <Uri/Uri.h>
+
+namespace
+{
+    /**
+     * These are prepended to the input of the keyed hash, so that the
+     * stream which scrambles a host never matches the one which scrambles
+     * the rest of a URI made up only of that host.
+     */
+    constexpr uint8_t HOST_DOMAIN = 0;
+    constexpr uint8_t CONTENT_DOMAIN = 1;
+
+    /**
+     * This is a small pseudo-random number generator (SplitMix64).
+     * It is only used to scramble characters, not for cryptography.
+     */
+    class Stream
+    {
+    public:
+        explicit Stream(uint64_t seed)
+            : state_(seed)
+        {
+        }
+
+        uint64_t Next()
+        {
+            uint64_t z = (state_ += 0x9e3779b97f4a7c15ull);
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+            return z ^ (z >> 31);
+        }
+
+        char Pick(char first, unsigned int count)
+        {
+            return (char)(first + (char)(Next() % count));
+        }
+
+    private:
+        uint64_t state_;
+    };
+
+    /**
+     * This computes SipHash-2-4, a keyed pseudo-random function, so that
+     * the scrambling cannot be predicted or reproduced without the key.
+     * The input is given one octet at a time.
+     */
+    class SipHash
+    {
+    public:
+        SipHash(uint64_t key0, uint64_t key1)
+            : v0_(key0 ^ 0x736f6d6570736575ull)
+            , v1_(key1 ^ 0x646f72616e646f6dull)
+            , v2_(key0 ^ 0x6c7967656e657261ull)
+            , v3_(key1 ^ 0x7465646279746573ull)
+        {
+        }
+
+        void Add(uint8_t octet)
+        {
+            word_ |= (uint64_t)octet << (8 * (length_ % 8));
+            if (++length_ % 8 == 0) {
+                Compress(word_);
+                word_ = 0;
+            }
+        }
+
+        uint64_t Finish()
+        {
+            Compress(word_ | ((uint64_t)length_ << 56));
+            v2_ ^= 0xff;
+            for (int i = 0; i < 4; ++i) {
+                Round();
+            }
+            return v0_ ^ v1_ ^ v2_ ^ v3_;
+        }
+
+    private:
+        static uint64_t Rotate(uint64_t x, int bits)
+        {
+            return (x << bits) | (x >> (64 - bits));
+        }
+
+        void Round()
+        {
+            v0_ += v1_;
+            v1_ = Rotate(v1_, 13);
+            v1_ ^= v0_;
+            v0_ = Rotate(v0_, 32);
+            v2_ += v3_;
+            v3_ = Rotate(v3_, 16);
+            v3_ ^= v2_;
+            v0_ += v3_;
+            v3_ = Rotate(v3_, 21);
+            v3_ ^= v0_;
+            v2_ += v1_;
+            v1_ = Rotate(v1_, 17);
+            v1_ ^= v2_;
+            v2_ = Rotate(v2_, 32);
+        }
+
+        void Compress(uint64_t m)
+        {
+            v3_ ^= m;
+            Round();
+            Round();
+            v0_ ^= m;
+        }
+
+        uint64_t v0_;
+        uint64_t v1_;
+        uint64_t v2_;
+        uint64_t v3_;
+        uint64_t word_ = 0;
+        size_t length_ = 0;
+    };
+
+    /**
+     * This function computes a seed for a scrambling stream, using a
+     * keyed hash of the given part of a string.
+     *
+     * @param[in] key
+     *      This is the secret key of the hash.
+     *
+     * @param[in] domain
+     *      This tells apart the streams used for different purposes.
+     *
+     * @param[in] s
+     *      This is the string containing the part to hash.
+     *
+     * @param[in] begin
+     *      This is the index of the first character to hash.
+     *
+     * @param[in] end
+     *      This is the index just past the last character to hash.
+     *
+     * @param[in] foldCase
+     *      This indicates whether or not uppercase letters should
+     *      be hashed as if they were lowercase.
+     *
+     * @return
+     *      The seed is returned.
+     */
+    uint64_t Seed(
+        const uint64_t (&key)[2],
+        uint8_t domain,
+        const std::string& s,
+        size_t begin,
+        size_t end,
+        bool foldCase
+    ) {
+        SipHash hash(key[0], key[1]);
+        hash.Add(domain);
+        for (size_t i = begin; i < end; ++i) {
+            auto c = (uint8_t)s[i];
+            if (foldCase && c >= 'A' && c <= 'Z') {
+                c = (uint8_t)(c - 'A' + 'a');
+            }
+            hash.Add(c);
+        }
+        return hash.Finish();
+    }
+
+    /**
+     * This holds one octet of a URI, which is either written as it is,
+     * or percent-encoded.
+     */
+    struct Octet {
+        /**
+         * This is the value of the octet.
+         */
+        uint8_t value = 0;
+
+        /**
+         * This is the index of the first character of the octet.
+         */
+        size_t position = 0;
+
+        /**
+         * This is the index just past the last character of the octet.
+         */
+        size_t next = 0;
+
+        /**
+         * This indicates whether or not the octet is percent-encoded.
+         */
+        bool escaped = false;
+
+        /**
+         * This indicates whether or not the octet is percent-encoded
+         * with lowercase hexadecimal digits.
+         */
+        bool lowercase = false;
+    };
+
+    /**
+     * This function returns the value of the given hexadecimal digit.
+     */
+    uint8_t HexValue(char c) {
+        if (c >= '0' && c <= '9') {
+            return (uint8_t)(c - '0');
+        }
+        else if (c >= 'a' && c <= 'f') {
+            return (uint8_t)(c - 'a' + 10);
+        }
+        else {
+            return (uint8_t)(c - 'A' + 10);
+        }
+    }
+
+    /**
+     * This function reads one octet from the given part of a string,
+     * decoding it if it is percent-encoded.
+     *
+     * @param[in] s
+     *      This is the string containing the octet.
+     *
+     * @param[in] i
+     *      This is the index of the first character of the octet.
+     *
+     * @param[in] end
+     *      This is the index just past the part of the string
+     *      which may be read.
+     *
+     * @return
+     *      The octet is returned.
+     */
+    Octet ReadOctet(const std::string& s, size_t i, size_t end) {
+        Octet octet;
+        octet.position = i;
+        if (
+            s[i] == '%'
+            && i + 2 < end
+            && isxdigit((unsigned char)s[i + 1])
+            && isxdigit((unsigned char)s[i + 2])
+        ) {
+            octet.value = (uint8_t)((HexValue(s[i + 1]) << 4) | HexValue(s[i + 2]));
+            octet.next = i + 3;
+            octet.escaped = true;
+            octet.lowercase = (
+                (s[i + 1] >= 'a' && s[i + 1] <= 'f')
+                || (s[i + 2] >= 'a' && s[i + 2] <= 'f')
+            );
+        }
+        else {
+            octet.value = (uint8_t)s[i];
+            octet.next = i + 1;
+        }
+        return octet;
+    }
+
+    /**
+     * This function replaces the given octet with a new value, keeping
+     * it percent-encoded, with the same case of hexadecimal digits,
+     * if it was.
+     *
+     * @param[in,out] s
+     *      This is the string containing the octet.
+     *
+     * @param[in] octet
+     *      This is the octet to replace.
+     *
+     * @param[in] value
+     *      This is the new value of the octet.
+     */
+    void WriteOctet(std::string& s, const Octet& octet, uint8_t value) {
+        if (octet.escaped) {
+            const auto digits = octet.lowercase ? "0123456789abcdef" : "0123456789ABCDEF";
+            s[octet.position + 1] = digits[value >> 4];
+            s[octet.position + 2] = digits[value & 0x0F];
+        }
+        else {
+            s[octet.position] = (char)value;
+        }
+    }
+
+    /**
+     * This function reads a well-formed UTF-8 sequence of more than
+     * one octet from the given part of a string.
+     *
+     * @param[in] s
+     *      This is the string containing the sequence.
+     *
+     * @param[in] first
+     *      This is the first octet of the sequence.
+     *
+     * @param[in] end
+     *      This is the index just past the part of the string
+     *      which may be read.
+     *
+     * @param[out] octets
+     *      This is where to store the octets of the sequence.
+     *
+     * @return
+     *      The number of octets in the sequence is returned.
+     *
+     * @retval 0
+     *      This is returned if there is no well-formed multi-octet
+     *      sequence starting with the given octet.
+     */
+    size_t ReadSequence(
+        const std::string& s,
+        const Octet& first,
+        size_t end,
+        Octet (&octets)[4]
+    ) {
+        // These are the bounds of the second octet, from the
+        // "Well-Formed UTF-8 Byte Sequences" table of Unicode.
+        size_t length;
+        uint8_t secondMin = 0x80;
+        uint8_t secondMax = 0xBF;
+        const auto lead = first.value;
+        if (lead >= 0xC2 && lead <= 0xDF) {
+            length = 2;
+        }
+        else if (lead >= 0xE0 && lead <= 0xEF) {
+            length = 3;
+            if (lead == 0xE0) {
+                secondMin = 0xA0;
+            }
+            else if (lead == 0xED) {
+                secondMax = 0x9F;
+            }
+        }
+        else if (lead >= 0xF0 && lead <= 0xF4) {
+            length = 4;
+            if (lead == 0xF0) {
+                secondMin = 0x90;
+            }
+            else if (lead == 0xF4) {
+                secondMax = 0x8F;
+            }
+        }
+        else {
+            return 0;
+        }
+        octets[0] = first;
+        for (size_t i = 1; i < length; ++i) {
+            if (octets[i - 1].next >= end) {
+                return 0;
+            }
+            octets[i] = ReadOctet(s, octets[i - 1].next, end);
+            const auto min = (i == 1) ? secondMin : 0x80;
+            const auto max = (i == 1) ? secondMax : 0xBF;
+            if (octets[i].value < min || octets[i].value > max) {
+                return 0;
+            }
+        }
+        return length;
+    }
+
+    /**
+     * This function replaces every character of the given part of a
+     * string with a random character of the same class.  Octets are
+     * classified after decoding any percent-encoding, which is kept:
+     * - letters and digits are replaced by letters of the same case,
+     *   or digits;
+     * - well-formed UTF-8 sequences are replaced by sequences encoding
+     *   another code point of the same encoded length, so that valid
+     *   UTF-8 stays valid;
+     * - other octets above 0x7F are replaced by octets of the same
+     *   kind (UTF-8 lead or continuation octet);
+     * - punctuation and control octets, which carry the structure of
+     *   the URI, are left untouched.
+     *
+     * @param[in,out] s
+     *      This is the string containing the part to scramble.
+     *
+     * @param[in] begin
+     *      This is the index of the first character to scramble.
+     *
+     * @param[in] end
+     *      This is the index just past the last character to scramble.
+     *
+     * @param[in] stream
+     *      This is the source of randomness to use.
+     */
+    void Scramble(std::string& s, size_t begin, size_t end, Stream& stream) {
+        for (size_t i = begin; i < end;) {
+            const auto octet = ReadOctet(s, i, end);
+            Octet sequence[4];
+            const auto length = ReadSequence(s, octet, end, sequence);
+            if (length > 0) {
+                // Pick a code point, other than a surrogate,
+                // which needs the same number of octets.
+                uint32_t codePoint;
+                uint8_t encoded[4];
+                if (length == 2) {
+                    codePoint = 0x80 + (uint32_t)(stream.Next() % (0x800 - 0x80));
+                    encoded[0] = (uint8_t)(0xC0 | (codePoint >> 6));
+                }
+                else if (length == 3) {
+                    codePoint = 0x800 + (uint32_t)(stream.Next() % (0x10000 - 0x800 - 0x800));
+                    if (codePoint >= 0xD800) {
+                        codePoint += 0x800;
+                    }
+                    encoded[0] = (uint8_t)(0xE0 | (codePoint >> 12));
+                }
+                else {
+                    codePoint = 0x10000 + (uint32_t)(stream.Next() % 0x100000);
+                    encoded[0] = (uint8_t)(0xF0 | (codePoint >> 18));
+                }
+                for (size_t j = 1; j < length; ++j) {
+                    encoded[j] = (uint8_t)(0x80 | ((codePoint >> (6 * (length - 1 - j))) & 0x3F));
+                }
+                for (size_t j = 0; j < length; ++j) {
+                    WriteOctet(s, sequence[j], encoded[j]);
+                }
+                i = sequence[length - 1].next;
+                continue;
+            }
+            const auto value = octet.value;
+            if (value >= 'a' && value <= 'z') {
+                WriteOctet(s, octet, (uint8_t)stream.Pick('a', 26));
+            }
+            else if (value >= 'A' && value <= 'Z') {
+                WriteOctet(s, octet, (uint8_t)stream.Pick('A', 26));
+            }
+            else if (value >= '0' && value <= '9') {
+                WriteOctet(s, octet, (uint8_t)stream.Pick('0', 10));
+            }
+            else if (value >= 0x80 && value <= 0xBF) {
+                WriteOctet(s, octet, (uint8_t)(0x80 + stream.Next() % 0x40));
+            }
+            else if (value >= 0xC0) {
+                WriteOctet(s, octet, (uint8_t)(0xC0 + stream.Next() % 0x40));
+            }
+            i = octet.next;
+        }
+    }
+
+    /**
+     * This function replaces every decimal octet of the given IPv4
+     * address with a random one of the same number of digits, so that
+     * the address stays valid: one digit maps to 0-9, two digits to
+     * 10-99 and three digits to 100-255.
+     *
+     * @param[in,out] s
+     *      This is the string containing the address.
+     *
+     * @param[in] begin
+     *      This is the index of the first character of the address.
+     *
+     * @param[in] end
+     *      This is the index just past the last character of the address.
+     *
+     * @param[in] stream
+     *      This is the source of randomness to use.
+     */
+    void ScrambleIPv4Address(std::string& s, size_t begin, size_t end, Stream& stream) {
+        for (size_t octetBegin = begin; octetBegin < end;) {
+            auto octetEnd = octetBegin;
+            while ((octetEnd < end) && (s[octetEnd] != '.')) {
+                ++octetEnd;
+            }
+            const auto numDigits = octetEnd - octetBegin;
+            unsigned int value;
+            if (numDigits == 1) {
+                value = (unsigned int)(stream.Next() % 10);
+            }
+            else if (numDigits == 2) {
+                value = 10 + (unsigned int)(stream.Next() % 90);
+            }
+            else {
+                value = 100 + (unsigned int)(stream.Next() % 156);
+            }
+            for (auto i = octetEnd; i > octetBegin; --i) {
+                s[i - 1] = (char)('0' + value % 10);
+                value /= 10;
+            }
+            octetBegin = octetEnd + 1;
+        }
+    }
+
+    /**
+     * This function replaces the characters of the given IP literal,
+     * such as "[fe80::1]" or "[v7.fe80]", so that it stays an IP literal
+     * of the same form: the version flag of an IPvFuture literal and all
+     * punctuation are kept, hexadecimal digits are replaced by hexadecimal
+     * digits of the same kind, other letters by letters of the same case,
+     * and a trailing IPv4 address as in ScrambleIPv4Address.
+     *
+     * @param[in,out] s
+     *      This is the string containing the literal.
+     *
+     * @param[in] begin
+     *      This is the index of the opening bracket of the literal.
+     *
+     * @param[in] end
+     *      This is the index just past the closing bracket of the literal.
+     *
+     * @param[in] stream
+     *      This is the source of randomness to use.
+     */
+    void ScrambleIPLiteral(std::string& s, size_t begin, size_t end, Stream& stream) {
+        auto i = begin + 1;
+        auto addressEnd = end;
+        if ((addressEnd > i) && (s[addressEnd - 1] == ']')) {
+            --addressEnd;
+        }
+        auto ipv4Begin = addressEnd;
+        if ((i < addressEnd) && ((s[i] == 'v') || (s[i] == 'V'))) {
+            ++i;
+        }
+        else {
+            // An IPv6 address may end with an IPv4 address.
+            const auto lastColon = s.rfind(':', addressEnd - 1);
+            if (
+                (lastColon != std::string::npos)
+                && (lastColon >= i)
+                && (s.find('.', lastColon) < addressEnd)
+            ) {
+                ipv4Begin = lastColon + 1;
+            }
+        }
+        for (; i < ipv4Begin; ++i) {
+            const auto c = s[i];
+            if (c >= '0' && c <= '9') {
+                s[i] = stream.Pick('0', 10);
+            }
+            else if (c >= 'a' && c <= 'f') {
+                s[i] = stream.Pick('a', 6);
+            }
+            else if (c >= 'A' && c <= 'F') {
+                s[i] = stream.Pick('A', 6);
+            }
+            else if (c >= 'a' && c <= 'z') {
+                s[i] = stream.Pick('a', 26);
+            }
+            else if (c >= 'A' && c <= 'Z') {
+                s[i] = stream.Pick('A', 26);
+            }
+        }
+        ScrambleIPv4Address(s, ipv4Begin, addressEnd, stream);
+    }
+}
+
+namespace Uri
+{
+    /**
+     * This contains the private properties of an Anonymizer instance.
+     */
+    struct Anonymizer::Impl {
+        /**
+         * This is the secret 128-bit key which seeds the scrambling.
+         */
+        uint64_t key[2] = {0, 0};
+    };
+
+    Anonymizer::~Anonymizer() = default;
+
+    Anonymizer::Anonymizer(uint64_t key0, uint64_t key1)
+        : impl_(new Impl)
+    {
+        impl_->key[0] = key0;
+        impl_->key[1] = key1;
+    }
+
+    bool Anonymizer::AnonymizeUri(
+        const std::string& uriString,
+        std::string& anonymizedUriString
+    ) const {
+        // Only rewrite what the parser accepts, so that the
+        // anonymized corpus exercises the same code paths.
+        Uri uri;
+        if (!uri.ParseFromString(uriString)) {
+            return false;
+        }
+
+        // The scheme is kept as it is.
+        size_t contentBegin = 0;
+        const auto scheme = uri.GetScheme();
+        if (!scheme.empty()) {
+            contentBegin = scheme.length() + 1;
+        }
+
+        // Take the host from where the parser found it, followed
+        // by the port number, if any.
+        const auto hostBegin = uri.GetHostOffset();
+        const auto hostEnd = hostBegin + uri.GetHost().length();
+        auto portEnd = hostEnd;
+        if (uri.HasPort()) {
+            ++portEnd;
+            while (
+                (portEnd < uriString.length())
+                && (uriString[portEnd] >= '0')
+                && (uriString[portEnd] <= '9')
+            ) {
+                ++portEnd;
+            }
+        }
+
+        anonymizedUriString = uriString;
+
+        // Scramble the host with a stream which depends only on the host,
+        // so that repeated hosts are mapped consistently.  IP addresses,
+        // which the parser tells apart from registered names by giving
+        // them no labels, are kept valid addresses of the same form.
+        Stream hostStream(
+            Seed(impl_->key, HOST_DOMAIN, uriString, hostBegin, hostEnd, true)
+        );
+        const auto hasHost = (hostEnd > hostBegin);
+        if (hasHost && (uriString[hostBegin] == '[')) {
+            ScrambleIPLiteral(anonymizedUriString, hostBegin, hostEnd, hostStream);
+        }
+        else if (hasHost && uri.GetHostLabels().empty()) {
+            ScrambleIPv4Address(anonymizedUriString, hostBegin, hostEnd, hostStream);
+        }
+        else {
+            Scramble(anonymizedUriString, hostBegin, hostEnd, hostStream);
+        }
+
+        // Scramble everything else but the port number.
+        Stream contentStream(
+            Seed(impl_->key, CONTENT_DOMAIN, uriString, 0, uriString.length(), false)
+        );
+        Scramble(anonymizedUriString, contentBegin, hostBegin, contentStream);
+        Scramble(anonymizedUriString, portEnd, uriString.length(), contentStream);
+        return true;
+    }
+}
@@ -0,0 +1,288 @@
+/**
+ * @file ShadowMode.cpp
+ *
+ * This module contains the implementation of the Uri::ShadowMode class.
+ *
+ */
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <Uri/ShadowMode.h>
+
+namespace
+{
+    /**
+     * This holds the elements of a parsed URI, so that the results
+     * of two engines can be compared.
+     */
+    struct Elements {
+        bool result = false;
+        std::string scheme;
+        std::string userInfo;
+        std::string host;
+        bool hasPort = false;
+        uint16_t port = 0;
+        std::vector<std::string> path;
+        std::string query;
+        std::string fragment;
+
+        Elements() = default;
+
+        Elements(const Uri::Uri& uri, bool result)
+            : result(result)
+        {
+            // The elements of a URI which failed to parse are meaningless.
+            if (!result) {
+                return;
+            }
+            scheme = uri.GetScheme();
+            userInfo = uri.GetUserInfo();
+            host = uri.GetHost();
+            hasPort = uri.HasPort();
+            port = uri.GetPort();
+            path = uri.GetPath();
+            query = uri.GetQuery();
+            fragment = uri.GetFragment();
+        }
+
+        bool operator==(const Elements& other) const {
+            return (
+                (result == other.result)
+                && (scheme == other.scheme)
+                && (userInfo == other.userInfo)
+                && (host == other.host)
+                && (hasPort == other.hasPort)
+                && (port == other.port)
+                && (path == other.path)
+                && (query == other.query)
+                && (fragment == other.fragment)
+            );
+        }
+    };
+
+    /**
+     * This is a call waiting to be compared.
+     */
+    struct Sample {
+        /**
+         * This is the string rendering of the URI that was parsed.
+         */
+        std::string uriString;
+
+        /**
+         * This is what the primary engine parsed.
+         */
+        Elements primary;
+
+        /**
+         * This is the time taken by the primary engine.
+         */
+        std::chrono::nanoseconds primaryTime;
+    };
+}
+
+namespace Uri
+{
+    /**
+     * This contains the private properties of a ShadowMode instance.
+     */
+    struct ShadowMode::Impl {
+        /**
+         * This is the fraction of calls to compare.
+         */
+        double sampleFraction = 0.0;
+
+        /**
+         * This is the maximum number of samples waiting to be compared.
+         */
+        size_t queueCapacity = 0;
+
+        /**
+         * These accumulate the statistics of the shadow mode.
+         */
+        std::atomic<uint64_t> sampled{0};
+        std::atomic<uint64_t> dropped{0};
+        std::atomic<uint64_t> compared{0};
+        std::atomic<uint64_t> divergences{0};
+        std::atomic<int64_t> primaryNanoseconds{0};
+        std::atomic<int64_t> shadowNanoseconds{0};
+
+        /**
+         * This protects the queue and the flags below.
+         */
+        std::mutex mutex;
+
+        /**
+         * This is used to wake up the worker thread when a sample
+         * is queued or the shadow mode is stopping.
+         */
+        std::condition_variable wakeCondition;
+
+        /**
+         * This is used to wake up WaitUntilIdle callers when the worker
+         * thread has finished comparing every queued sample.
+         */
+        std::condition_variable idleCondition;
+
+        /**
+         * These are the samples waiting to be compared.
+         */
+        std::deque<Sample> queue;
+
+        /**
+         * This indicates whether or not the worker thread is
+         * currently comparing a sample.
+         */
+        bool busy = false;
+
+        /**
+         * This indicates whether or not the worker thread should stop.
+         */
+        bool stop = false;
+
+        /**
+         * This is the thread which compares the samples.
+         */
+        std::thread worker;
+
+        /**
+         * This is the body of the worker thread.
+         *
+         * @param[in] engine
+         *      This is the engine to compare against the primary one.
+         */
+        void Worker(ParseEngine engine) {
+            Uri shadow;
+            shadow.SetParseEngine(engine);
+            std::unique_lock<std::mutex> lock(mutex);
+            for (;;) {
+                busy = false;
+                if (queue.empty()) {
+                    idleCondition.notify_all();
+                }
+                wakeCondition.wait(lock, [this]{ return stop || !queue.empty(); });
+                if (stop) {
+                    break;
+                }
+                auto sample = std::move(queue.front());
+                queue.pop_front();
+                busy = true;
+                lock.unlock();
+
+                const auto start = std::chrono::steady_clock::now();
+                const auto result = shadow.ParseFromString(sample.uriString);
+                const auto shadowTime = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - start
+                );
+                if (!(Elements(shadow, result) == sample.primary)) {
+                    ++divergences;
+                }
+                primaryNanoseconds += sample.primaryTime.count();
+                shadowNanoseconds += shadowTime.count();
+                ++compared;
+
+                lock.lock();
+            }
+        }
+    };
+
+    ShadowMode::~ShadowMode() {
+        {
+            std::lock_guard<std::mutex> lock(impl_->mutex);
+            impl_->stop = true;
+        }
+        impl_->wakeCondition.notify_one();
+        impl_->worker.join();
+    }
+
+    ShadowMode::ShadowMode(
+        ParseEngine engine,
+        double sampleFraction,
+        size_t queueCapacity
+    )
+        : impl_(new Impl)
+    {
+        if (sampleFraction < 0.0) {
+            sampleFraction = 0.0;
+        }
+        else if (sampleFraction > 1.0) {
+            sampleFraction = 1.0;
+        }
+        impl_->sampleFraction = sampleFraction;
+        impl_->queueCapacity = queueCapacity;
+        impl_->worker = std::thread(&Impl::Worker, impl_.get(), engine);
+    }
+
+    bool ShadowMode::ShouldSample()
+    {
+        // Each thread draws from its own generator (SplitMix64), so that
+        // parsing threads never contend for shared state, and the decision
+        // for one shadow mode does not depend on calls made to another.
+        thread_local uint64_t state = std::random_device()();
+        uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        z ^= (z >> 31);
+
+        // Turn the top 53 bits into a number in [0, 1).
+        if ((double)(z >> 11) * 0x1.0p-53 >= impl_->sampleFraction) {
+            return false;
+        }
+        impl_->sampled.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    void ShadowMode::Submit(
+        const std::string& uriString,
+        const Uri& primary,
+        bool primaryResult,
+        std::chrono::nanoseconds primaryTime
+    ) {
+        // Only copy the elements once the sample is accepted, so that
+        // dropping a sample costs the caller nothing.  The worker thread
+        // may wait for the copy, but the caller never waits for it.
+        std::unique_lock<std::mutex> lock(impl_->mutex, std::try_to_lock);
+        if (
+            !lock.owns_lock()
+            || impl_->stop
+            || (impl_->queue.size() >= impl_->queueCapacity)
+        ) {
+            impl_->dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        impl_->queue.push_back(Sample{
+            uriString,
+            Elements(primary, primaryResult),
+            primaryTime
+        });
+        lock.unlock();
+        impl_->wakeCondition.notify_one();
+    }
+
+    void ShadowMode::WaitUntilIdle()
+    {
+        std::unique_lock<std::mutex> lock(impl_->mutex);
+        impl_->idleCondition.wait(
+            lock,
+            [this]{ return impl_->queue.empty() && !impl_->busy; }
+        );
+    }
+
+    auto ShadowMode::GetStatistics() const -> Statistics
+    {
+        Statistics statistics;
+        statistics.sampled = impl_->sampled;
+        statistics.dropped = impl_->dropped;
+        statistics.compared = impl_->compared;
+        statistics.divergences = impl_->divergences;
+        statistics.primaryTime = std::chrono::nanoseconds(impl_->primaryNanoseconds);
+        statistics.shadowTime = std::chrono::nanoseconds(impl_->shadowNanoseconds);
+        return statistics;
+    }
+}
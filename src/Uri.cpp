@@ -5,15 +5,163 @@
  * 
  */
 
+#include <chrono>
 #include <stdexcept>
 #include <string>
 #include <vector>
 #include <regex>
 #include <iostream>
+#include <Uri/ShadowMode.h>
 #include <Uri/Uri.h>
 
+namespace
+{
+    /**
+     * This function determines whether or not the given character is
+     * an ASCII letter.
+     */
+    bool IsAlpha(char c) {
+        return ((c >= 'A') && (c <= 'Z')) || ((c >= 'a') && (c <= 'z'));
+    }
+
+    /**
+     * This function determines whether or not the given character is
+     * an ASCII decimal digit.
+     */
+    bool IsDigit(char c) {
+        return (c >= '0') && (c <= '9');
+    }
+
+    /**
+     * This function determines whether or not the given character is
+     * an ASCII hexadecimal digit.
+     */
+    bool IsHexDigit(char c) {
+        return IsDigit(c) || ((c >= 'A') && (c <= 'F')) || ((c >= 'a') && (c <= 'f'));
+    }
+
+    /**
+     * This function checks the given scheme one character at a time,
+     * accepting exactly what the regular expression
+     * "^[A-Za-z][A-Za-z0-9\\+\\-\\.]*$" accepts.
+     *
+     * @param[in] scheme
+     *      This is the scheme to validate.
+     *
+     * @return
+     *      An indication of whether or not the scheme is valid is returned.
+     */
+    bool ScanScheme(const std::string& scheme) {
+        if (scheme.empty() || !IsAlpha(scheme[0])) {
+            return false;
+        }
+        for (auto c : scheme) {
+            if (
+                !IsAlpha(c)
+                && !IsDigit(c)
+                && (c != '+')
+                && (c != '-')
+                && (c != '.')
+            ) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * This function checks the given userinfo one character at a time,
+     * accepting exactly what the userinfo regular expression accepts:
+     * unreserved characters, sub-delimiters, ":" and percent-encoded
+     * octets.
+     *
+     * @param[in] userInfo
+     *      This is the userinfo to validate.
+     *
+     * @return
+     *      An indication of whether or not the userinfo is valid is returned.
+     */
+    bool ScanUserInfo(const std::string& userInfo) {
+        static const std::string allowed = "-._~!$&'()*+,;:=";
+        for (size_t i = 0; i < userInfo.length(); ++i) {
+            const auto c = userInfo[i];
+            if (c == '%') {
+                if (
+                    (i + 2 >= userInfo.length())
+                    || !IsHexDigit(userInfo[i + 1])
+                    || !IsHexDigit(userInfo[i + 2])
+                ) {
+                    return false;
+                }
+                i += 2;
+            }
+            else if (
+                !IsAlpha(c)
+                && !IsDigit(c)
+                && (allowed.find(c) == std::string::npos)
+            ) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * This function checks whether or not the given host is an IPv4
+     * address, using the "IPv4address" rule of RFC 3986, which takes
+     * precedence over the "reg-name" rule.
+     *
+     * @param[in] host
+     *      This is the host to check.
+     *
+     * @return
+     *      An indication of whether or not the host is an IPv4
+     *      address is returned.
+     */
+    bool IsIPv4Address(const std::string& host) {
+        size_t numOctets = 0;
+        size_t octetBegin = 0;
+        for (;;) {
+            auto octetEnd = host.find('.', octetBegin);
+            if (octetEnd == std::string::npos) {
+                octetEnd = host.length();
+            }
+            const auto octetLength = octetEnd - octetBegin;
+            if (
+                (octetLength == 0)
+                || (octetLength > 3)
+                || ((octetLength > 1) && (host[octetBegin] == '0'))
+            ) {
+                return false;
+            }
+            unsigned int octet = 0;
+            for (size_t i = octetBegin; i < octetEnd; ++i) {
+                if (!IsDigit(host[i])) {
+                    return false;
+                }
+                octet = octet * 10 + (unsigned int)(host[i] - '0');
+            }
+            if (octet > 255) {
+                return false;
+            }
+            ++numOctets;
+            if (octetEnd == host.length()) {
+                break;
+            }
+            octetBegin = octetEnd + 1;
+        }
+        return numOctets == 4;
+    }
+}
+
 namespace Uri
 {
+    /**
+     * This is the number of host labels whose boundaries are stored
+     * inside a Uri instance, rather than in separately allocated memory.
+     */
+    constexpr size_t INLINE_HOST_LABELS = 8;
+
     /**
      * This contains the private properties of a Uri instance.
      */
@@ -33,6 +181,32 @@ namespace Uri
          */
         std::string host;
 
+        /**
+         * This is the index of the "host" element in the
+         * string rendering of the URI.
+         */
+        size_t hostOffset = 0;
+
+        /**
+         * This is the number of labels in the "host" element of the URI,
+         * if it is a registered name.
+         */
+        size_t numHostLabels = 0;
+
+        /**
+         * These are the offsets, within the "host" element of the URI,
+         * just past the end of each label, for hosts with no more than
+         * INLINE_HOST_LABELS labels.
+         */
+        uint32_t inlineHostLabelEnds[INLINE_HOST_LABELS];
+
+        /**
+         * These are the offsets, within the "host" element of the URI,
+         * just past the end of each label, for hosts with more than
+         * INLINE_HOST_LABELS labels.
+         */
+        std::vector<uint32_t> hostLabelEnds;
+
         /**
          * This flag indicates whether or not the
          * URI includes a port number.
@@ -59,6 +233,16 @@ namespace Uri
          * This is the "fragment" element of the URI.
          */
         std::string fragment;
+
+        /**
+         * This is the engine used to validate the elements of the URI.
+         */
+        ParseEngine engine = ParseEngine::Regex;
+
+        /**
+         * This is the shadow mode attached to the instance, if any.
+         */
+        std::shared_ptr<ShadowMode> shadowMode;
     };
 
     Uri::~Uri() = default;
@@ -69,6 +253,28 @@ namespace Uri
     }
 
     bool Uri::ParseFromString(const std::string& uriString)
+    {
+        if (
+            (impl_->shadowMode == nullptr)
+            || !impl_->shadowMode->ShouldSample()
+        ) {
+            return parse(uriString);
+        }
+
+        // Time the primary parse so it can be compared with the shadow.
+        const auto start = std::chrono::steady_clock::now();
+        const auto result = parse(uriString);
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        impl_->shadowMode->Submit(
+            uriString,
+            *this,
+            result,
+            std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed)
+        );
+        return result;
+    }
+
+    bool Uri::parse(const std::string& uriString)
     {
         // First parse the scheme.
         size_t nextIdx;
@@ -77,13 +283,16 @@ namespace Uri
             return false;
         }
         impl_->scheme = schemeString;
+        const auto restIdx = nextIdx;
         auto rest = uriString.substr(nextIdx);
 
         // Next, parse the userinfo, host, and port number.
-        std::string authority = parseAuthority(rest, nextIdx);
+        size_t authorityIdx;
+        std::string authority = parseAuthority(rest, authorityIdx, nextIdx);
         if (!parseAuthorityComponents(authority)) {
             return false;
         }
+        impl_->hostOffset += restIdx + authorityIdx;
         rest = rest.substr(nextIdx);
 
         // Next, parse the fragment if there is one.
@@ -145,6 +354,20 @@ namespace Uri
         return impl_->host;
     }
 
+    HostLabels Uri::GetHostLabels() const
+    {
+        const uint32_t* labelEnds = impl_->inlineHostLabelEnds;
+        if (impl_->numHostLabels > INLINE_HOST_LABELS) {
+            labelEnds = impl_->hostLabelEnds.data();
+        }
+        return HostLabels(impl_->host, labelEnds, impl_->numHostLabels);
+    }
+
+    size_t Uri::GetHostOffset() const
+    {
+        return impl_->hostOffset;
+    }
+
     std::vector<std::string> Uri::GetPath() const
     {
         return impl_->path;
@@ -185,6 +408,16 @@ namespace Uri
         return impl_->fragment;
     }
 
+    void Uri::SetParseEngine(ParseEngine engine)
+    {
+        impl_->engine = engine;
+    }
+
+    void Uri::SetShadowMode(std::shared_ptr<ShadowMode> shadowMode)
+    {
+        impl_->shadowMode = shadowMode;
+    }
+
     bool Uri::parseScheme(const std::string& uri, std::string& scheme, size_t& nextIdx)
     {
         const auto schemeEnd = uri.find(":");
@@ -207,9 +440,16 @@ namespace Uri
         std::string schemeString = uri.substr(0, schemeEnd);
 
         // Validate scheme string
-        std::regex re("^[A-Za-z][A-Za-z0-9\\+\\-\\.]*$");
-        if (!std::regex_match(schemeString, re)) {
-            return false;
+        if (impl_->engine == ParseEngine::Scanner) {
+            if (!ScanScheme(schemeString)) {
+                return false;
+            }
+        }
+        else {
+            std::regex re("^[A-Za-z][A-Za-z0-9\\+\\-\\.]*$");
+            if (!std::regex_match(schemeString, re)) {
+                return false;
+            }
         }
 
         scheme = schemeString;
@@ -217,8 +457,9 @@ namespace Uri
         return true;
     }
 
-    std::string Uri::parseAuthority(const std::string& uri, size_t& nextIdx)
+    std::string Uri::parseAuthority(const std::string& uri, size_t& authorityIdx, size_t& nextIdx)
     {
+        authorityIdx = 0;
         const auto doubleForwardSlash = uri.find("//");
         if (doubleForwardSlash == std::string::npos) {
             // if there is no "//", then there is no authority
@@ -239,6 +480,7 @@ namespace Uri
             authorityEnd = uri.length();
         }
 
+        authorityIdx = doubleForwardSlash + 2;
         nextIdx = authorityEnd;
         return uri.substr(doubleForwardSlash + 2, authorityEnd - 2);
     }
@@ -247,6 +489,8 @@ namespace Uri
     {
         impl_->userInfo.clear();
         impl_->host.clear();
+        impl_->hostOffset = 0;
+        impl_->numHostLabels = 0;
         impl_->port = 0;
         impl_->hasPort = false;
 
@@ -256,9 +500,16 @@ namespace Uri
             std::string userInfo = authority.substr(0, userinfoDelim);
 
             // Validate UserInfo
-            std::regex re("^(?:(?=%)%[0-9A-Fa-f]{2}|[0-9A-Za-z\\-\\._~\\!\\$\\&\\'\\(\\)\\*\\+\\,\\;\\:\\=])*$");
-            if (!std::regex_match(userInfo, re)) {
-                return false;
+            if (impl_->engine == ParseEngine::Scanner) {
+                if (!ScanUserInfo(userInfo)) {
+                    return false;
+                }
+            }
+            else {
+                std::regex re("^(?:(?=%)%[0-9A-Fa-f]{2}|[0-9A-Za-z\\-\\._~\\!\\$\\&\\'\\(\\)\\*\\+\\,\\;\\:\\=])*$");
+                if (!std::regex_match(userInfo, re)) {
+                    return false;
+                }
             }
 
             // Extract pct-encoded characters
@@ -271,6 +522,7 @@ namespace Uri
             impl_->userInfo = userInfo;
             nextIdx = userinfoDelim + 1;
         }
+        impl_->hostOffset = nextIdx;
 
         const auto portDelim = authority.find(":", nextIdx);
         if (portDelim != std::string::npos) {
@@ -294,6 +546,34 @@ namespace Uri
             impl_->host = authority.substr(nextIdx);
         }
 
+        // Record where the labels of a registered name end.
+        const auto& host = impl_->host;
+        if (
+            host.empty()
+            || (host[0] == '[')
+            || IsIPv4Address(host)
+        ) {
+            return true;
+        }
+        impl_->numHostLabels = 1;
+        for (auto c : host) {
+            if (c == '.') {
+                ++impl_->numHostLabels;
+            }
+        }
+        auto labelEnds = impl_->inlineHostLabelEnds;
+        if (impl_->numHostLabels > INLINE_HOST_LABELS) {
+            impl_->hostLabelEnds.resize(impl_->numHostLabels);
+            labelEnds = impl_->hostLabelEnds.data();
+        }
+        size_t label = 0;
+        for (size_t i = 0; i < host.length(); ++i) {
+            if (host[i] == '.') {
+                labelEnds[label++] = (uint32_t)i;
+            }
+        }
+        labelEnds[label] = (uint32_t)host.length();
+
         return true;
     }
     
@@ -6,6 +6,7 @@
  */
 
 #include <gtest/gtest.h>
+#include <algorithm>
 #include <stddef.h>
 #include <Uri/Uri.h>
 
@@ -357,4 +358,109 @@ TEST(UriTests, ParseFromStringUserInfoBarelyLegal) {
         ASSERT_EQ(testVector.userInfo, uri.GetUserInfo()) << "URI: " << testVector.uriString;
         ++index;
     }
-}
\ No newline at end of file
+}
+
+TEST(UriTests, ParseFromStringScannerEngineMatchesRegexEngine) {
+    const std::vector<std::string> testVectors{
+        "http://www.example.com/",
+        "h://www.example.com/",
+        "x+-.0://www.example.com/",
+        "://www.example.com/",
+        "0://www.example.com/",
+        "h@://www.example.com/",
+        "//%41@www.example.com/",
+        "//%4@www.example.com/",
+        "//%X@www.example.com/",
+        "//{@www.example.com/",
+        "//@www.example.com/",
+        "//-._~!$&'()*+,;:=aZ9@www.example.com/",
+    };
+
+    for (const auto& testVector : testVectors) {
+        Uri::Uri regex;
+        Uri::Uri scanner;
+        scanner.SetParseEngine(Uri::ParseEngine::Scanner);
+
+        const auto regexResult = regex.ParseFromString(testVector);
+        ASSERT_EQ(regexResult, scanner.ParseFromString(testVector)) << "URI: " << testVector;
+        if (regexResult) {
+            ASSERT_EQ(regex.GetScheme(), scanner.GetScheme()) << "URI: " << testVector;
+            ASSERT_EQ(regex.GetUserInfo(), scanner.GetUserInfo()) << "URI: " << testVector;
+        }
+    }
+}
+
+TEST(UriTests, ParseFromStringHostLabels) {
+    struct TestVector {
+        std::string uriString;
+        std::vector<std::string> labels;
+    };
+
+    const std::vector<TestVector> testVectors{
+        {"http://www.example.com/", {"www", "example", "com"}},
+        {"http://joe@Example.COM:8080/", {"Example", "COM"}},
+        {"http://localhost/", {"localhost"}},
+        {"http://example.com./", {"example", "com", ""}},
+        {"http://a..b/", {"a", "", "b"}},
+        {"http://a.b.c.d.e.f.g.h.i.j/", {"a", "b", "c", "d", "e", "f", "g", "h", "i", "j"}},
+        {"http://1.2.3.4/", {}},
+        {"http://1.2.3.256/", {"1", "2", "3", "256"}},
+        {"http://1.2.3/", {"1", "2", "3"}},
+        {"http://[v7.fe80]/", {}},
+        {"urn:book:fantasy:Hobbit", {}},
+        {"/foo", {}},
+    };
+
+    for (const auto& testVector : testVectors) {
+        Uri::Uri uri;
+
+        ASSERT_TRUE(uri.ParseFromString(testVector.uriString)) << "URI: " << testVector.uriString;
+        const auto labels = uri.GetHostLabels();
+        ASSERT_EQ(testVector.labels.size(), labels.size()) << "URI: " << testVector.uriString;
+        std::vector<std::string> forward;
+        for (auto label : labels) {
+            forward.emplace_back(label);
+        }
+        ASSERT_EQ(testVector.labels, forward) << "URI: " << testVector.uriString;
+        std::vector<std::string> reverse;
+        for (auto label : uri.GetHostLabels().Reverse()) {
+            reverse.emplace_back(label);
+        }
+        std::reverse(forward.begin(), forward.end());
+        ASSERT_EQ(forward, reverse) << "URI: " << testVector.uriString;
+    }
+}
+
+TEST(UriTests, ParseFromStringTwiceFirstWithHostLabelsThenWithout) {
+    Uri::Uri uri;
+
+    ASSERT_TRUE(uri.ParseFromString("http://a.b.c.d.e.f.g.h.i.j/"));
+    ASSERT_EQ(10, uri.GetHostLabels().size());
+    ASSERT_TRUE(uri.ParseFromString("/foo/bar"));
+    ASSERT_TRUE(uri.GetHostLabels().empty());
+    ASSERT_TRUE(uri.ParseFromString("http://www.example.com/"));
+    ASSERT_EQ("example", uri.GetHostLabels()[1]);
+}
+
+TEST(UriTests, ParseFromStringHostOffset) {
+    struct TestVector {
+        std::string uriString;
+        size_t hostOffset;
+    };
+
+    const std::vector<TestVector> testVectors{
+        {"http://www.example.com/", 7},
+        {"http://joe@www.example.com:8080/", 11},
+        {"//www.example.com", 2},
+        {"https://[v7.fe80]:443/", 8},
+        {"urn:book:fantasy:Hobbit", 4},
+        {"/foo", 0},
+    };
+
+    for (const auto& testVector : testVectors) {
+        Uri::Uri uri;
+
+        ASSERT_TRUE(uri.ParseFromString(testVector.uriString)) << "URI: " << testVector.uriString;
+        ASSERT_EQ(testVector.hostOffset, uri.GetHostOffset()) << "URI: " << testVector.uriString;
+    }
+}